@@ -6,90 +6,22 @@
 // Visual studio mandates the the PCH source header file is included.
 #include "extlibs.hpp"
 #include "assets.hpp"
+#include "reader.hpp"
 
 namespace fs = boost::filesystem;
 namespace al = boost::algorithm;
 using namespace std;
 
 namespace xrextract {
-  void extract_assets(const data_file& df) {
-    array<char, 4096> rdbuff;
-    ifstream dat_in {df.dat.string()};
-    unsigned int chunks_to_read{ 0 }, remainder_to_read{ 0 };
-    
-    for (const asset_entry& ae : df.assets) {
-      if (ae.skip) {
-        dat_in.seekg(ae.size, ios_base::cur);
-        continue;
-      }
-
-      if (ae.size == 0) {
-        cout << "info: deleting file " << ae.filename.string() << endl;
-        fs::remove(ae.filename);
-        continue;
-      }
-      
-      fs::path asset_path {df.dest_dir};
-      asset_path /= ae.filename;
-      
-      cout << "info: extracting " << ae.filename.string() << " to " << asset_path.string() << endl;
-      
-      fs::create_directories(asset_path.parent_path());
-
-      ofstream asset_out {asset_path.string(), ios_base::out | ios_base::binary | ios_base::trunc};
-      
-      // Implementation should round the quotient towards zero, after C++11.
-      for (chunks_to_read = (ae.size / rdbuff.size()); chunks_to_read > 0; --chunks_to_read) {
-        // Clear read buffer.
-        fill(rdbuff.begin(), rdbuff.end(), 0);
-        // Read from .dat file.
-        dat_in.read(rdbuff.data(), rdbuff.size());
-        // Make sure the exact amount was written.
-        if (dat_in.good()) {
-          if (dat_in.gcount() == rdbuff.size()) {
-            // Write out read buffer to asset file output stream.
-            asset_out.write(rdbuff.data(), dat_in.gcount());
-            if (!asset_out.good()) {
-              throw runtime_error("error: could not write to asset file");
-            }
-          }
-          else {
-            cerr << "error: expected to read " << rdbuff.size() << ", read: " << dat_in.gcount() << endl;
-            throw runtime_error("error: incorrect amount of bytes read from .dat file");
-          }
-        }
-        else {
-          throw runtime_error("error: there was in issue while reading the .dat");
-        }
-      }
-      
-      remainder_to_read = ae.size % rdbuff.size();
-      if (remainder_to_read) {
-        fill(rdbuff.begin(), rdbuff.end(), 0);
-        dat_in.read(rdbuff.data(), remainder_to_read);
-        if (dat_in.good()) {
-          if (dat_in.gcount() == remainder_to_read) {
-            // Write out read buffer to asset file output stream.
-            asset_out.write(rdbuff.data(), dat_in.gcount());
-            if (!asset_out.good()) {
-              throw runtime_error("error: could not write to asset file");
-            }
-          }
-          else {
-            throw runtime_error("error: incorrect amount of bytes read from .dat file");
-          }
-        }
-        else {
-          throw runtime_error("error: there was in issue while reading the .dat");
-        }
-      }
-
-      // @TODO Implement file MD5 checksum.
-      // @TODO Apply timestamp.
-    };
-  };
+  void extract_stats::sample_page_cache() {
+    chrono::time_point<chrono::steady_clock> now = chrono::steady_clock::now();
+    if (1 <= chrono::duration_cast<chrono::seconds>(now - sampled).count()) {
+      page_cache_peak = max(page_cache_peak, page_cache_size());
+      sampled = now;
+    }
+  }
   
-  asset_entries get_assets(const data_file& df) {
+  asset_entries get_assets(const data_file& df, bool progress) {
     asset_entries entries {};
     basic_ifstream<string::value_type> in(df.cat.native(), ios_base::in | ios_base::binary);
     // Enable stream exception throws for non-recoverable error states.
@@ -108,13 +40,15 @@ namespace xrextract {
 
     auto cout_precision = cout.precision();
     auto cout_flags = cout.flags();
-    cout << fixed;
-    cout.precision(2);
     chrono::time_point<chrono::steady_clock>
       start_time = chrono::steady_clock::now(),
       current_time = chrono::steady_clock::now();
     
-    cout << "info: get assets list from file " << df.cat.string() <<  "... " << flush;
+    if (progress) {
+      cout << fixed;
+      cout.precision(2);
+      cout << "info: get assets list from file " << df.cat.string() <<  "... " << flush;
+    }
 
     // Line number counter.
     uint32_t ln { 0 };
@@ -151,7 +85,10 @@ namespace xrextract {
       }
 
       readprog = ((readbytes / filebytes) * 100);
-      if (1 <= chrono::duration_cast<chrono::seconds>(current_time - start_time).count()) {
+      if (!progress) {
+        // Nothing to report.
+      }
+      else if (1 <= chrono::duration_cast<chrono::seconds>(current_time - start_time).count()) {
         cout << readprog << "% " << flush;
         
         start_time = chrono::steady_clock::now();
@@ -239,12 +176,45 @@ namespace xrextract {
       entries.push_back(ae);
     }
 
-    cout << readprog << "% " << flush;
-    cout << "done" << endl;
+    if (progress) {
+      cout << readprog << "% " << flush;
+      cout << "done" << endl;
 
-    cout.precision(cout_precision);
-    cout.flags(cout_flags);
+      cout.precision(cout_precision);
+      cout.flags(cout_flags);
+    }
     
     return entries;
   };  
+
+  void load_assets(data_file_entries& dfs) {
+    // A single catalog gets the progress report, several are parsed in
+    // parallel and only reported once done.
+    if (dfs.size() == 1) {
+      dfs.front().assets = get_assets(dfs.front(), true);
+      return;
+    }
+
+    mutex report {};
+    atomic<size_t> next {0};
+    auto worker = [&]() {
+      for (size_t i = next++; i < dfs.size(); i = next++) {
+        dfs[i].assets = get_assets(dfs[i], false);
+
+        lock_guard<mutex> lock {report};
+        cout << "info: got " << dfs[i].assets.size() << " assets from file " << dfs[i].cat.string() << endl;
+      }
+    };
+
+    size_t workers = min<size_t>(max(thread::hardware_concurrency(), 1u), dfs.size());
+    vector<future<void>> pending {};
+    for (size_t i = 1; i < workers; ++i) {
+      pending.push_back(async(launch::async, worker));
+    }
+    worker();
+    for (future<void>& f : pending) {
+      // Rethrows anything the worker threw.
+      f.get();
+    }
+  }
 }
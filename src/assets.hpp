@@ -7,6 +7,7 @@
 #define __ASSETS_HPP
 
 #include "extlibs.hpp"
+#include "writer.hpp"
 
 namespace fs = boost::filesystem;
 using namespace std;
@@ -75,10 +76,42 @@ namespace xrextract {
 
   /**
    * Retrieve asset entries from a data file.
+   *
+   * @param bool progress
+   *   Whether to report parsing progress on the standard output.
    */
-  asset_entries get_assets(const data_file& df);
+  asset_entries get_assets(const data_file& df, bool progress);
 
-  void extract_assets(const data_file& df);
+  /**
+   * Retrieve asset entries of all data files, parsing catalogs in parallel.
+   */
+  void load_assets(data_file_entries& dfs);
+
+  /**
+   * How assets are extracted.
+   */
+  struct extract_options {
+    write_options write;
+    /**
+    * Keep the page cache footprint flat, see dat_reader and asset_writer.
+    */
+    bool cache_friendly;
+  };
+
+  /**
+   * Running totals of an extraction, for the run summary.
+   */
+  struct extract_stats {
+    uint64_t assets;
+    uint64_t bytes;
+    uint64_t page_cache_peak;
+    chrono::time_point<chrono::steady_clock> sampled;
+
+    /**
+     * Update the page cache peak, at most once a second.
+     */
+    void sample_page_cache();
+  };
 }
 
 #endif // __ASSETS_HPP
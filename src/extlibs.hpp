@@ -17,12 +17,33 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <deque>
+#include <array>
 #include <algorithm>
 #include <regex>
 #include <chrono>
+#include <iomanip>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <functional>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <limits>
 // C++ STD C headers.
 #include <cstdlib>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+// POSIX headers.
+# if defined(POSIX_API)
+#include <fcntl.h>
+#include <unistd.h>
+# endif
 
 // Boost headers.
 #include <boost/algorithm/string.hpp>
@@ -0,0 +1,18 @@
+/**
+ * @file
+ * Asset extraction loop instantiations.
+ */
+
+// Visual studio mandates the the PCH source header file is included.
+#include "extlibs.hpp"
+#include "extract.hpp"
+
+using namespace std;
+
+namespace xrextract {
+  // The command line only uses the file, null and hash sinks. Instantiating
+  // the library sinks here keeps them compiled with every build.
+  template class callback_sink<function<void(const asset_entry&, const char*, size_t)>>;
+  template void extract_assets(const data_file&, const extract_options&, extract_stats&, memory_sink&);
+  template void extract_assets(const data_file&, const extract_options&, extract_stats&, asset_callback_sink&);
+}
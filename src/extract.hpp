@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Asset extraction loop.
+ */
+
+#ifndef __EXTRACT_HPP
+#define __EXTRACT_HPP
+
+#include "extlibs.hpp"
+#include "assets.hpp"
+#include "reader.hpp"
+#include "sinks.hpp"
+
+using namespace std;
+
+namespace xrextract {
+  /**
+   * Extract the assets of a data file into a sink.
+   *
+   * Defined here so each sink gets its own instantiation, with the sink's
+   * write() inlined into the copy loop. See sinks.hpp for what a sink
+   * has to provide.
+   */
+  template <typename Sink>
+  void extract_assets(const data_file& df, const extract_options& opts, extract_stats& stats, Sink& sink) {
+    // Read buffer, heap allocated due to its size.
+    vector<char> rdbuff(1 << 20);
+    dat_reader dat_in {df.dat, opts.cache_friendly};
+
+    for (const asset_entry& ae : df.assets) {
+      if (ae.skip) {
+        dat_in.skip(ae.size);
+        continue;
+      }
+
+      if (ae.size == 0) {
+        sink.removed(df, ae);
+        continue;
+      }
+
+      sink.begin(df, ae);
+      for (uint64_t remaining = ae.size; remaining > 0; ) {
+        size_t chunk = static_cast<size_t>(min<uint64_t>(remaining, rdbuff.size()));
+        dat_in.read(rdbuff.data(), chunk);
+        sink.write(rdbuff.data(), chunk);
+        remaining -= chunk;
+        // Sampled while copying, large assets may be dropped from the
+        // page cache by the time they are done.
+        stats.sample_page_cache();
+      }
+      sink.end(ae);
+
+      stats.assets++;
+      stats.bytes += ae.size;
+    }
+  }
+
+  // Library entry points, compiled once in extract.cpp.
+  extern template void extract_assets(const data_file&, const extract_options&, extract_stats&, memory_sink&);
+  extern template void extract_assets(const data_file&, const extract_options&, extract_stats&, asset_callback_sink&);
+}
+
+#endif // __EXTRACT_HPP
@@ -34,10 +34,11 @@ namespace xrextract {
         cat_file,
         dat_file
       };
-      // See the todo in the data_file declaration.
-      df.assets = move(get_assets(df));
       data_files.push_back(df);
     }
+
+    // See the todo in the data_file declaration.
+    load_assets(data_files);
     
     return data_files;
   }
@@ -97,22 +98,22 @@ namespace xrextract {
       }
 
       if (!data_files.empty()) {
+        load_assets(data_files);
+
+# if defined(VERBOSE)
         for (data_file& entry : data_files) {
           // Leaving this comment block as a reference:
           // On Win32, fs::path::value_type is a wide character.
           // Can this conversion poitentially lead to loss of / invalid data being outputted?
           // cout << "\t" << entry.cat.filename().string() << ": " << flush;
 
-          entry.assets = move(get_assets(entry));
-
-# if defined(VERBOSE)
           cout << "\n\n" << entry.cat.filename().string() << ": " << flush;
           for (const asset_entry& ae : entry.assets) {
             cout << ae.filename.string() << ", sz: " << ae.size << endl;
           }
           cout << endl;
-# endif
         }
+# endif
       }
       else {
         cerr << "error: cat files found, but no dat files in directory: " << data_dir << endl;
@@ -124,4 +125,10 @@ namespace xrextract {
 
     return data_files;
   }
+
+# if defined(POSIX_API)
+  runtime_error posix_error(const string& what, const fs::path& path, int err) {
+    return runtime_error("error: " + what + " " + path.string() + ": " + strerror(err));
+  }
+# endif
 }
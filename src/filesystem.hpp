@@ -22,6 +22,16 @@ namespace xrextract {
    * Retrieve data files from a directory.
    */
   data_file_entries get_data_files_from_directory(const fs::path& data_dir);
+
+# if defined(POSIX_API)
+  /**
+   * Build an exception for a failed system call on a file.
+   *
+   * @param int err
+   *   The errno value of the failed call.
+   */
+  runtime_error posix_error(const string& what, const fs::path& path, int err);
+# endif
 }
 
 #endif // __FILESYSTEM_HPP
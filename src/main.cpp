@@ -11,7 +11,9 @@
 
 #include "extlibs.hpp"
 #include "assets.hpp"
+#include "extract.hpp"
 #include "filesystem.hpp"
+#include "query.hpp"
 
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
@@ -54,7 +56,18 @@ int main(int argc, char* argv[]) {
       ("data-file,f", po::value< vector<string> >(), "provide a list of .cat file; can be used multiple times")
       ("destination-dir,D", po::value<string>(), "destination directory")
       ("list-assets,l", "list assets for each data file")
+      ("query,q", po::value<string>(), "aggregate assets of all data files without extracting; one of assets, directories, extensions, largest, data-files")
+      ("sort", po::value<string>()->default_value("size"), "query result order; one of size, count, name")
+      ("format", po::value<string>()->default_value("text"), "query output format; one of text, json, csv")
+      ("top,n", po::value<size_t>()->default_value(0), "output at most this many query results; 0 for all, the largest query defaults to 10")
+      ("depth", po::value<unsigned int>()->default_value(1), "number of directory levels the directories query groups by")
+      ("query-output,o", po::value<string>(), "write query results to this file instead of the standard output")
       ("filter-assets,F", po::value< string >(), "extract assets matching the given regular expression, visit http://en.cppreference.com/w/cpp/regex/ecmascript for more info")
+      ("preallocate", "reserve the full size of each asset file before writing it")
+      ("direct-io-threshold", po::value<uint64_t>()->default_value(0), "write assets of at least this many bytes with direct I/O, bypassing the page cache; 0 disables")
+      ("sync", po::value<string>()->default_value("none"), "when to sync extracted assets to storage; one of none, file (each asset), batch (once at the end)")
+      ("cache-friendly", "hint sequential reads, prefetch ahead and drop read and written data from the page cache as extraction progresses")
+      ("sink", po::value<string>()->default_value("file"), "where extracted assets go; one of file, null (read only, for benchmarking), hash (verify checksums without writing)")
       ("version,v", "print program information")
       ;
 
@@ -84,6 +97,36 @@ int main(int argc, char* argv[]) {
       filter = filter_pattern;
     }
 
+    xr::query_options query_opts {};
+    if (vm.count("query")) {
+      query_opts.kind = xr::parse_query_kind(vm["query"].as<string>());
+      query_opts.sort = xr::parse_query_sort(vm["sort"].as<string>());
+      query_opts.format = xr::parse_query_format(vm["format"].as<string>());
+      query_opts.top = vm["top"].as<size_t>();
+      query_opts.depth = vm["depth"].as<unsigned int>();
+    }
+
+    // Query results own the standard output, so everything else written
+    // to it goes to the standard error instead.
+    ostream query_stdout {cout.rdbuf()};
+    if (vm.count("query")) {
+      cout.rdbuf(cerr.rdbuf());
+    }
+
+    xr::extract_options extract_opts {
+      {
+        vm.count("preallocate") > 0,
+        vm["direct-io-threshold"].as<uint64_t>(),
+        xr::parse_sync_mode(vm["sync"].as<string>())
+      },
+      vm.count("cache-friendly") > 0
+    };
+
+    xr::sink_kind sink = xr::parse_sink_kind(vm["sink"].as<string>());
+    xr::file_sink file_out {extract_opts};
+    xr::null_sink null_out {};
+    xr::hash_sink hash_out {};
+
     xr::data_file_entries dfs {};
     
     if (vm.count("data-dir")) {
@@ -110,18 +153,29 @@ int main(int argc, char* argv[]) {
     }
 
     if (dfs.empty() == false) {
-      fs::path dest_dir {fs::current_path()};
-      if (vm.count("destination-dir")) {
-        dest_dir = vm["destination-dir"].as<string>();
-        if (!dest_dir.is_absolute()) {
-          dest_dir = absolute(dest_dir);
+      const bool extracting {!vm.count("list-assets") && !vm.count("query")};
+
+      // Listing and querying only read the catalogs, and only the file
+      // sink writes to a destination.
+      fs::path dest_dir {};
+      if (extracting && sink == xr::sink_kind::file) {
+        dest_dir = fs::current_path();
+        if (vm.count("destination-dir")) {
+          dest_dir = vm["destination-dir"].as<string>();
+          if (!dest_dir.is_absolute()) {
+            dest_dir = absolute(dest_dir);
+          }
+        }
+        cout << "info: destination directory: " << dest_dir.string() << endl;
+        if (!fs::exists(dest_dir)) {
+          fs::create_directories(dest_dir);
         }
       }
-      cout << "info: destination directory: " << dest_dir.string() << endl;
-      if (!fs::exists(dest_dir)) {
-        fs::create_directories(dest_dir);
-      }
-      
+
+      chrono::time_point<chrono::steady_clock> start_time {chrono::steady_clock::now()};
+      uint64_t page_cache_start {xr::page_cache_size()};
+      xr::extract_stats stats {0, 0, page_cache_start, start_time};
+
       for (xr::data_file& df : dfs) {
         cout << "info: data file [" << df.dat.string() << "] has " << df.assets.size() << " assets" << endl;
         df.dest_dir = dest_dir;
@@ -162,15 +216,82 @@ int main(int argc, char* argv[]) {
             }
           }
         }
+        else if (vm.count("query")) {
+          // Queried once all data files are filtered, see below.
+        }
         else if (assets_count) {
           cout << "info: extracting assets: " << endl;
-          xr::extract_assets(df);
+          switch (sink) {
+            case xr::sink_kind::file:
+              xr::extract_assets(df, extract_opts, stats, file_out);
+              break;
+            case xr::sink_kind::null:
+              xr::extract_assets(df, extract_opts, stats, null_out);
+              break;
+            case xr::sink_kind::hash:
+              xr::extract_assets(df, extract_opts, stats, hash_out);
+              break;
+          }
           cout << "info: done extracting assets" << endl;
         }
         else {
           cout << "info: no assets to extract" << endl;
         }
       }
+
+      if (extracting && sink == xr::sink_kind::file) {
+        file_out.finish();
+      }
+
+      if (extracting && sink == xr::sink_kind::file && extract_opts.write.sync == xr::sync_mode::batch) {
+        cout << "info: syncing destination directory" << endl;
+        xr::sync_destination(dest_dir);
+      }
+
+      if (extracting) {
+        double seconds {chrono::duration<double>(chrono::steady_clock::now() - start_time).count()};
+        double mib {static_cast<double>(stats.bytes) / (1 << 20)};
+        uint64_t page_cache_end {xr::page_cache_size()};
+        stats.page_cache_peak = max(stats.page_cache_peak, page_cache_end);
+
+        auto cout_precision = cout.precision();
+        auto cout_flags = cout.flags();
+        cout << fixed;
+        cout.precision(2);
+        cout << "info: extracted " << stats.assets << " assets, " << mib << " MiB in " << seconds << " s";
+        if (seconds > 0) {
+          cout << " (" << (mib / seconds) << " MiB/s)";
+        }
+        cout << endl;
+        if (page_cache_start) {
+          cout << "info: page cache " << (static_cast<double>(page_cache_start) / (1 << 20)) << " MiB at start, "
+               << (static_cast<double>(page_cache_end) / (1 << 20)) << " MiB at end, "
+               << (static_cast<double>(stats.page_cache_peak) / (1 << 20)) << " MiB peak" << endl;
+        }
+        cout.precision(cout_precision);
+        cout.flags(cout_flags);
+      }
+
+      if (extracting && sink == xr::sink_kind::hash) {
+        cout << "info: " << hash_out.mismatches << " checksum mismatches" << endl;
+        if (hash_out.mismatches) {
+          return EXIT_FAILURE;
+        }
+      }
+
+      if (vm.count("query")) {
+        xr::query_rows rows = xr::run_query(dfs, query_opts);
+        if (vm.count("query-output")) {
+          ofstream query_out {vm["query-output"].as<string>(), ios_base::out | ios_base::trunc};
+          if (!query_out.good()) {
+            throw runtime_error("error: could not open query output file");
+          }
+          xr::print_query(query_out, rows, query_opts);
+        }
+        else {
+          xr::print_query(query_stdout, rows, query_opts);
+        }
+      }
     }
   }
   catch(exception& e) {
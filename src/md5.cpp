@@ -0,0 +1,135 @@
+/**
+ * @file
+ * MD5 checksum definitions file.
+ */
+
+// Visual studio mandates the the PCH source header file is included.
+#include "extlibs.hpp"
+#include "md5.hpp"
+
+using namespace std;
+
+namespace xrextract {
+  namespace {
+    const array<uint32_t, 64> sines {{
+      0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+      0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+      0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+      0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+      0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+      0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+      0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+      0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+    }};
+
+    const array<unsigned int, 64> shifts {{
+      7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+      5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+      4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+      6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+    }};
+
+    inline uint32_t rotate_left(uint32_t x, unsigned int n) {
+      return (x << n) | (x >> (32 - n));
+    }
+  }
+
+  md5_hash::md5_hash() {
+    reset();
+  }
+
+  void md5_hash::reset() {
+    state = {{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476}};
+    length = 0;
+  }
+
+  void md5_hash::update(const char* data, size_t count) {
+    const unsigned char* in {reinterpret_cast<const unsigned char*>(data)};
+    size_t used = length % block.size();
+    length += count;
+
+    // Top up a partially filled block first.
+    if (used) {
+      size_t chunk = min(count, block.size() - used);
+      memcpy(block.data() + used, in, chunk);
+      in += chunk;
+      count -= chunk;
+      if (used + chunk < block.size()) {
+        return;
+      }
+      transform(block.data());
+    }
+
+    // Hash whole blocks straight from the input.
+    for (; count >= block.size(); count -= block.size(), in += block.size()) {
+      transform(in);
+    }
+
+    memcpy(block.data(), in, count);
+  }
+
+  md5sum md5_hash::hexdigest() {
+    uint64_t bits {length * 8};
+    const char padding[64] {'\x80'};
+    size_t used = length % block.size();
+    update(padding, (used < 56 ? 56 : 120) - used);
+
+    char size_bytes[8];
+    for (size_t i = 0; i < 8; ++i) {
+      size_bytes[i] = static_cast<char>(bits >> (8 * i));
+    }
+    update(size_bytes, sizeof(size_bytes));
+
+    md5sum digest {};
+    const char hex[] {"0123456789abcdef"};
+    for (size_t i = 0; i < 16; ++i) {
+      unsigned int byte = (state[i / 4] >> (8 * (i % 4))) & 0xff;
+      digest[i * 2] = hex[byte >> 4];
+      digest[i * 2 + 1] = hex[byte & 0xf];
+    }
+    digest[32] = '\0';
+    return digest;
+  }
+
+  void md5_hash::transform(const unsigned char* in) {
+    uint32_t words[16];
+    for (size_t i = 0; i < 16; ++i) {
+      words[i] = static_cast<uint32_t>(in[i * 4])
+        | (static_cast<uint32_t>(in[i * 4 + 1]) << 8)
+        | (static_cast<uint32_t>(in[i * 4 + 2]) << 16)
+        | (static_cast<uint32_t>(in[i * 4 + 3]) << 24);
+    }
+
+    uint32_t a {state[0]}, b {state[1]}, c {state[2]}, d {state[3]};
+    for (unsigned int i = 0; i < 64; ++i) {
+      uint32_t f;
+      unsigned int g;
+      if (i < 16) {
+        f = (b & c) | (~b & d);
+        g = i;
+      }
+      else if (i < 32) {
+        f = (d & b) | (~d & c);
+        g = (5 * i + 1) % 16;
+      }
+      else if (i < 48) {
+        f = b ^ c ^ d;
+        g = (3 * i + 5) % 16;
+      }
+      else {
+        f = c ^ (b | ~d);
+        g = (7 * i) % 16;
+      }
+      uint32_t rotated = d;
+      d = c;
+      c = b;
+      b = b + rotate_left(a + f + sines[i] + words[g], shifts[i]);
+      a = rotated;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+  }
+}
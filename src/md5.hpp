@@ -0,0 +1,43 @@
+/**
+ * @file
+ * MD5 checksum declarations.
+ */
+
+#ifndef __MD5_HPP
+#define __MD5_HPP
+
+#include "extlibs.hpp"
+#include "assets.hpp"
+
+using namespace std;
+
+namespace xrextract {
+  /**
+   * Incremental MD5 hash, as described in RFC 1321.
+   */
+  class md5_hash {
+  public:
+    md5_hash();
+
+    /**
+     * Start over, for hashing a new asset.
+     */
+    void reset();
+
+    void update(const char* data, size_t count);
+
+    /**
+     * Finish hashing and return the checksum as lower case hex digits.
+     */
+    md5sum hexdigest();
+
+  private:
+    void transform(const unsigned char* in);
+
+    array<uint32_t, 4> state;
+    array<unsigned char, 64> block;
+    uint64_t length;
+  };
+}
+
+#endif // __MD5_HPP
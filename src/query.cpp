@@ -0,0 +1,316 @@
+/**
+ * @file
+ * Asset query definitions file.
+ */
+
+// Visual studio mandates the the PCH source header file is included.
+#include "extlibs.hpp"
+#include "query.hpp"
+
+namespace fs = boost::filesystem;
+namespace al = boost::algorithm;
+using namespace std;
+
+namespace xrextract {
+  namespace {
+    /**
+    * Number of rows the largest query outputs when no limit is given.
+    */
+    const size_t default_largest_count {10};
+
+    /**
+    * Running totals of a group of assets.
+    */
+    struct aggregate {
+      uint64_t count;
+      uint64_t size;
+    };
+
+    typedef unordered_map<string, aggregate> aggregate_map;
+
+    /**
+    * Directory prefix of an asset, cut after `depth` path components.
+    *
+    * Asset names in .cat files always use forward slashes.
+    */
+    string directory_key(const string& filename, unsigned int depth) {
+      string::size_type last = filename.rfind('/');
+      if (last == string::npos || depth == 0) {
+        return ".";
+      }
+
+      string::size_type pos {0}, end {last};
+      for (unsigned int i = 0; i < depth; ++i) {
+        end = filename.find('/', pos);
+        if (end >= last) {
+          end = last;
+          break;
+        }
+        pos = end + 1;
+      }
+
+      return filename.substr(0, end);
+    }
+
+    /**
+    * Lower case file extension of an asset, including the dot.
+    */
+    string extension_key(const string& filename) {
+      string::size_type dot = filename.rfind('.');
+      string::size_type slash = filename.rfind('/');
+      if (dot == string::npos || (slash != string::npos && dot < slash)) {
+        return "(none)";
+      }
+
+      return al::to_lower_copy(filename.substr(dot));
+    }
+
+    bool row_order(const query_row& a, const query_row& b, query_sort sort) {
+      switch (sort) {
+        case query_sort::size:
+          if (a.size != b.size) {
+            return a.size > b.size;
+          }
+          break;
+        case query_sort::count:
+          if (a.count != b.count) {
+            return a.count > b.count;
+          }
+          break;
+        case query_sort::name:
+          break;
+      }
+
+      if (a.key != b.key) {
+        return a.key < b.key;
+      }
+      return a.source < b.source;
+    }
+
+    /**
+    * Keep only the `n` largest rows, in no particular order.
+    */
+    void keep_largest(query_rows& rows, size_t n) {
+      if (rows.size() <= n) {
+        return;
+      }
+
+      nth_element(rows.begin(), rows.begin() + n, rows.end(), [](const query_row& a, const query_row& b) {
+          return row_order(a, b, query_sort::size);
+        });
+      rows.resize(n);
+    }
+
+    /**
+    * Add the assets of a single data file to the query result, in one pass.
+    *
+    * Per asset rows and data file totals go to `rows`, grouped totals
+    * to `groups`.
+    */
+    void aggregate_data_file(const data_file& df, const query_options& opts, size_t largest, aggregate_map& groups, query_rows& rows) {
+      const string source {fs::path(df.name).string()};
+      aggregate total {0, 0};
+
+      for (const asset_entry& ae : df.assets) {
+        // A zero size marks an asset removed by this data file, it takes
+        // no space.
+        if (ae.skip || ae.size == 0) {
+          continue;
+        }
+
+        total.count++;
+        total.size += ae.size;
+
+        switch (opts.kind) {
+          case query_kind::assets:
+          case query_kind::largest:
+            rows.push_back({ae.filename.generic_string(), source, 1, ae.size});
+            break;
+          case query_kind::directories: {
+            aggregate& group = groups[directory_key(ae.filename.generic_string(), opts.depth)];
+            group.count++;
+            group.size += ae.size;
+            break;
+          }
+          case query_kind::extensions: {
+            aggregate& group = groups[extension_key(ae.filename.generic_string())];
+            group.count++;
+            group.size += ae.size;
+            break;
+          }
+          case query_kind::data_files:
+            break;
+        }
+      }
+
+      if (opts.kind == query_kind::largest) {
+        // Bounds memory to `largest` rows plus one data file's assets.
+        keep_largest(rows, largest);
+      }
+      else if (opts.kind == query_kind::data_files) {
+        rows.push_back({source, {}, total.count, total.size});
+      }
+    }
+
+    string json_escape(const string& s) {
+      string escaped {};
+      escaped.reserve(s.size());
+      for (const char ch : s) {
+        switch (ch) {
+          case '"': escaped += "\\\""; break;
+          case '\\': escaped += "\\\\"; break;
+          case '\n': escaped += "\\n"; break;
+          case '\r': escaped += "\\r"; break;
+          case '\t': escaped += "\\t"; break;
+          default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+              char code[8];
+              snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned int>(ch));
+              escaped += code;
+            }
+            else {
+              escaped += ch;
+            }
+        }
+      }
+      return escaped;
+    }
+
+    string csv_escape(const string& s) {
+      if (s.find_first_of(",\"\r\n") == string::npos) {
+        return s;
+      }
+      string escaped {"\""};
+      for (const char ch : s) {
+        if (ch == '"') {
+          escaped += '"';
+        }
+        escaped += ch;
+      }
+      escaped += '"';
+      return escaped;
+    }
+  }
+
+  query_kind parse_query_kind(const string& name) {
+    if (name == "assets") {
+      return query_kind::assets;
+    }
+    if (name == "directories") {
+      return query_kind::directories;
+    }
+    if (name == "extensions") {
+      return query_kind::extensions;
+    }
+    if (name == "largest") {
+      return query_kind::largest;
+    }
+    if (name == "data-files") {
+      return query_kind::data_files;
+    }
+    throw invalid_argument("unknown query `" + name + "`, expected one of assets, directories, extensions, largest, data-files");
+  }
+
+  query_sort parse_query_sort(const string& name) {
+    if (name == "size") {
+      return query_sort::size;
+    }
+    if (name == "count") {
+      return query_sort::count;
+    }
+    if (name == "name") {
+      return query_sort::name;
+    }
+    throw invalid_argument("unknown sort order `" + name + "`, expected one of size, count, name");
+  }
+
+  query_format parse_query_format(const string& name) {
+    if (name == "text") {
+      return query_format::text;
+    }
+    if (name == "json") {
+      return query_format::json;
+    }
+    if (name == "csv") {
+      return query_format::csv;
+    }
+    throw invalid_argument("unknown output format `" + name + "`, expected one of text, json, csv");
+  }
+
+  query_rows run_query(const data_file_entries& dfs, const query_options& opts) {
+    const size_t largest {opts.top ? opts.top : default_largest_count};
+    query_rows rows {};
+    aggregate_map groups {};
+    for (const data_file& df : dfs) {
+      aggregate_data_file(df, opts, largest, groups, rows);
+    }
+    for (const aggregate_map::value_type& group : groups) {
+      rows.push_back({group.first, {}, group.second.count, group.second.size});
+    }
+
+    size_t limit {opts.kind == query_kind::largest ? largest : opts.top};
+    if (opts.kind == query_kind::largest) {
+      keep_largest(rows, largest);
+    }
+
+    auto order = [&opts](const query_row& a, const query_row& b) {
+      return row_order(a, b, opts.sort);
+    };
+    if (limit && limit < rows.size()) {
+      partial_sort(rows.begin(), rows.begin() + limit, rows.end(), order);
+      rows.resize(limit);
+    }
+    else {
+      sort(rows.begin(), rows.end(), order);
+    }
+
+    return rows;
+  }
+
+  void print_query(ostream& out, const query_rows& rows, const query_options& opts) {
+    // Which data file an asset belongs to only matters for per asset rows.
+    const bool with_source {opts.kind == query_kind::assets || opts.kind == query_kind::largest};
+
+    switch (opts.format) {
+      case query_format::text: {
+        uint64_t total_count {0}, total_size {0};
+        for (const query_row& row : rows) {
+          out << setw(14) << row.size << ' ' << setw(8) << row.count << ' ' << row.key;
+          if (with_source) {
+            out << " [" << row.source << "]";
+          }
+          out << '\n';
+          total_count += row.count;
+          total_size += row.size;
+        }
+        out << setw(14) << total_size << ' ' << setw(8) << total_count << " total" << endl;
+        break;
+      }
+      case query_format::json: {
+        out << "[";
+        for (query_rows::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+          out << (it == rows.begin() ? "\n" : ",\n");
+          out << "  {\"key\": \"" << json_escape(it->key) << "\", ";
+          if (with_source) {
+            out << "\"source\": \"" << json_escape(it->source) << "\", ";
+          }
+          out << "\"count\": " << it->count << ", \"size\": " << it->size << "}";
+        }
+        out << "\n]" << endl;
+        break;
+      }
+      case query_format::csv: {
+        out << "key," << (with_source ? "source," : "") << "count,size\n";
+        for (const query_row& row : rows) {
+          out << csv_escape(row.key) << ',';
+          if (with_source) {
+            out << csv_escape(row.source) << ',';
+          }
+          out << row.count << ',' << row.size << '\n';
+        }
+        out << flush;
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * Asset query declarations.
+ */
+
+#ifndef __QUERY_HPP
+#define __QUERY_HPP
+
+#include "extlibs.hpp"
+#include "assets.hpp"
+
+using namespace std;
+
+namespace xrextract {
+  /**
+   * What a query aggregates the assets by.
+   */
+  enum class query_kind {
+    // Every asset, one row each.
+    assets,
+    // Directory prefix of the asset, up to a given depth.
+    directories,
+    // File extension of the asset.
+    extensions,
+    // The largest assets over all data files.
+    largest,
+    // The data file the asset belongs to.
+    data_files
+  };
+
+  /**
+   * Order of the query result rows.
+   */
+  enum class query_sort {
+    // Biggest total size first.
+    size,
+    // Biggest asset count first.
+    count,
+    // Alphabetical by key.
+    name
+  };
+
+  /**
+   * Output format of the query result.
+   */
+  enum class query_format {
+    text,
+    json,
+    csv
+  };
+
+  /**
+   * Query parameters, as given on the command line.
+   */
+  struct query_options {
+    query_kind kind;
+    query_sort sort;
+    query_format format;
+    /**
+    * Maximum number of rows to output, zero means all of them.
+    *
+    * The largest query falls back to ten rows when zero.
+    */
+    size_t top;
+    /**
+    * Number of path components kept for the directories query.
+    */
+    unsigned int depth;
+  };
+
+  /**
+   * A single aggregated query result.
+   */
+  struct query_row {
+    string key;
+    // Data file name, only set for per asset rows.
+    string source;
+    uint64_t count;
+    uint64_t size;
+  };
+
+  /**
+   * A container for query result rows.
+   */
+  typedef vector<query_row> query_rows;
+
+  /**
+   * Parse a query kind name.
+   *
+   * @throws invalid_argument on unknown names.
+   */
+  query_kind parse_query_kind(const string& name);
+
+  /**
+   * Parse a query sort order name.
+   *
+   * @throws invalid_argument on unknown names.
+   */
+  query_sort parse_query_sort(const string& name);
+
+  /**
+   * Parse a query output format name.
+   *
+   * @throws invalid_argument on unknown names.
+   */
+  query_format parse_query_format(const string& name);
+
+  /**
+   * Aggregate the assets of all data files.
+   *
+   * Only the parsed catalogs are used, the .dat files are never read.
+   * Assets marked to be skipped or as removed are left out. Each data file
+   * is aggregated in one pass over its assets.
+   */
+  query_rows run_query(const data_file_entries& dfs, const query_options& opts);
+
+  /**
+   * Write query result rows in the requested format.
+   */
+  void print_query(ostream& out, const query_rows& rows, const query_options& opts);
+}
+
+#endif // __QUERY_HPP
@@ -0,0 +1,150 @@
+/**
+ * @file
+ * Data file reader definitions file.
+ */
+
+// Visual studio mandates the the PCH source header file is included.
+#include "extlibs.hpp"
+#include "reader.hpp"
+#include "filesystem.hpp"
+
+namespace fs = boost::filesystem;
+using namespace std;
+
+namespace xrextract {
+  namespace {
+    /**
+    * How far ahead of the read position is prefetched.
+    *
+    * Assets skipped by a filter inside the window get prefetched too, so
+    * keep it small compared to a typical .dat file.
+    */
+    const uint64_t readahead_window {8 << 20};
+
+    /**
+    * How much has to be consumed before it is dropped from the page cache.
+    */
+    const uint64_t release_chunk {4 << 20};
+  }
+
+  dat_reader::dat_reader(const fs::path& path, bool cache_friendly)
+    : path {path},
+      cache_friendly {cache_friendly},
+      offset {0},
+      size {fs::file_size(path)},
+      prefetched {0},
+      released {0}
+  {
+# if defined(WINDOWS_API)
+    in.open(path.string(), ios_base::in | ios_base::binary);
+    if (!in.good()) {
+      throw runtime_error("error: could not open .dat file " + path.string());
+    }
+# else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw posix_error("could not open .dat file", path, errno);
+    }
+#   if defined(POSIX_FADV_SEQUENTIAL)
+    if (cache_friendly) {
+      // Advice is best effort, failures are not worth stopping for.
+      posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      advise();
+    }
+#   endif
+# endif
+  }
+
+  dat_reader::~dat_reader() {
+# if defined(POSIX_API)
+#   if defined(POSIX_FADV_DONTNEED)
+    if (cache_friendly) {
+      posix_fadvise(fd, released, 0, POSIX_FADV_DONTNEED);
+    }
+#   endif
+    ::close(fd);
+# endif
+  }
+
+  void dat_reader::read(char* data, size_t count) {
+# if defined(WINDOWS_API)
+    in.read(data, count);
+    if (static_cast<size_t>(in.gcount()) != count) {
+      cerr << "error: expected to read " << count << ", read: " << in.gcount() << endl;
+      throw runtime_error("error: incorrect amount of bytes read from .dat file");
+    }
+    offset += count;
+# else
+    size_t total {0};
+    while (total < count) {
+      ssize_t got = ::read(fd, data + total, count - total);
+      if (got < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw posix_error("there was in issue while reading", path, errno);
+      }
+      if (got == 0) {
+        cerr << "error: expected to read " << count << ", read: " << total << endl;
+        throw runtime_error("error: incorrect amount of bytes read from .dat file");
+      }
+      total += got;
+    }
+    offset += count;
+    if (cache_friendly) {
+      advise();
+    }
+# endif
+  }
+
+  void dat_reader::skip(uint64_t count) {
+    offset += count;
+# if defined(WINDOWS_API)
+    in.seekg(count, ios_base::cur);
+# else
+    if (lseek(fd, offset, SEEK_SET) < 0) {
+      throw posix_error("could not seek in", path, errno);
+    }
+    if (cache_friendly) {
+      advise();
+    }
+# endif
+  }
+
+  void dat_reader::advise() {
+    // Not every POSIX system has posix_fadvise(), e.g. macOS.
+# if defined(POSIX_FADV_WILLNEED) && defined(POSIX_FADV_DONTNEED)
+    // Only top the window up once half of it is consumed, to keep the
+    // number of syscalls down for small assets.
+    uint64_t window_end {min(offset + readahead_window, size)};
+    if (prefetched < offset) {
+      prefetched = offset;
+    }
+    if (window_end > prefetched && (window_end - prefetched >= readahead_window / 2 || window_end == size)) {
+      posix_fadvise(fd, prefetched, window_end - prefetched, POSIX_FADV_WILLNEED);
+      prefetched = window_end;
+    }
+
+    if (offset - released >= release_chunk) {
+      posix_fadvise(fd, released, offset - released, POSIX_FADV_DONTNEED);
+      released = offset;
+    }
+# endif
+  }
+
+  uint64_t page_cache_size() {
+# if defined(__linux__)
+    ifstream meminfo {"/proc/meminfo"};
+    string key {};
+    uint64_t kib {0};
+    while (meminfo >> key >> kib) {
+      if (key == "Cached:") {
+        return kib * 1024;
+      }
+      // Skip the unit.
+      meminfo.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+# endif
+    return 0;
+  }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Data file reader declarations.
+ */
+
+#ifndef __READER_HPP
+#define __READER_HPP
+
+#include "extlibs.hpp"
+
+namespace fs = boost::filesystem;
+using namespace std;
+
+namespace xrextract {
+  /**
+   * Sequential reader of a .dat file.
+   *
+   * In the cache friendly mode, the kernel is told the file is read
+   * sequentially, a window ahead of the read position is prefetched and
+   * everything behind it is dropped from the page cache. The hints are only
+   * given on POSIX systems.
+   */
+  class dat_reader {
+  public:
+    dat_reader(const fs::path& path, bool cache_friendly);
+    dat_reader(const dat_reader&) = delete;
+    dat_reader& operator=(const dat_reader&) = delete;
+    ~dat_reader();
+
+    /**
+     * Read exactly `count` bytes.
+     *
+     * @throws runtime_error when the .dat file ends early.
+     */
+    void read(char* data, size_t count);
+
+    /**
+     * Move the read position `count` bytes forward.
+     */
+    void skip(uint64_t count);
+
+  private:
+    /**
+     * Prefetch ahead of and release behind the read position.
+     */
+    void advise();
+
+    fs::path path;
+    bool cache_friendly;
+    uint64_t offset;
+    uint64_t size;
+    // Everything before this offset was asked to be prefetched.
+    uint64_t prefetched;
+    // Everything before this offset was dropped from the page cache.
+    uint64_t released;
+# if defined(WINDOWS_API)
+    ifstream in;
+# else
+    int fd;
+# endif
+  };
+
+  /**
+   * Size of the system wide page cache in bytes, zero when not known.
+   */
+  uint64_t page_cache_size();
+}
+
+#endif // __READER_HPP
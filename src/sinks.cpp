@@ -0,0 +1,74 @@
+/**
+ * @file
+ * Extraction sink definitions file.
+ */
+
+// Visual studio mandates the the PCH source header file is included.
+#include "extlibs.hpp"
+#include "sinks.hpp"
+
+namespace fs = boost::filesystem;
+using namespace std;
+
+namespace xrextract {
+  sink_kind parse_sink_kind(const string& name) {
+    if (name == "file") {
+      return sink_kind::file;
+    }
+    if (name == "null") {
+      return sink_kind::null;
+    }
+    if (name == "hash") {
+      return sink_kind::hash;
+    }
+    throw invalid_argument("unknown sink `" + name + "`, expected one of file, null, hash");
+  }
+
+  file_sink::file_sink(const extract_options& opts)
+    : opts {opts}
+  {}
+
+  void file_sink::begin(const data_file& df, const asset_entry& ae) {
+    fs::path asset_path {df.dest_dir};
+    asset_path /= ae.filename;
+
+    cout << "info: extracting " << ae.filename.string() << " to " << asset_path.string() << endl;
+
+    fs::create_directories(asset_path.parent_path());
+
+    out.reset(new asset_writer {asset_path, ae.size, opts.write, opts.cache_friendly ? &releaser : nullptr});
+  }
+
+  void file_sink::end(const asset_entry&) {
+    out->close();
+    out.reset();
+
+    // @TODO Apply timestamp.
+  }
+
+  void file_sink::removed(const data_file& df, const asset_entry& ae) {
+    fs::path asset_path {df.dest_dir};
+    asset_path /= ae.filename;
+
+    cout << "info: deleting file " << asset_path.string() << endl;
+    fs::remove(asset_path);
+  }
+
+  void file_sink::finish() {
+    releaser.drain();
+  }
+
+  void hash_sink::begin(const data_file& df, const asset_entry&) {
+    hash.reset();
+    current = &df;
+  }
+
+  void hash_sink::end(const asset_entry& ae) {
+    md5sum digest = hash.hexdigest();
+    if (strncmp(digest.data(), ae.checksum.data(), 32) != 0) {
+      cerr << "error: checksum mismatch for asset `" << ae.filename.string() << "` in " << current->dat.string()
+           << ", expected " << ae.checksum.data() << ", got " << digest.data() << endl;
+      mismatches++;
+    }
+  }
+}
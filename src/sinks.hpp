@@ -0,0 +1,181 @@
+/**
+ * @file
+ * Extraction sink declarations.
+ *
+ * A sink receives the contents of each extracted asset, see extract.hpp.
+ * Every sink provides:
+ *
+ *   void begin(const data_file& df, const asset_entry& ae);
+ *   void write(const char* data, size_t count);
+ *   void end(const asset_entry& ae);
+ *   void removed(const data_file& df, const asset_entry& ae);
+ *
+ * write() is called for every chunk read from the .dat file and is defined
+ * inline, so it gets inlined into the extraction loop.
+ */
+
+#ifndef __SINKS_HPP
+#define __SINKS_HPP
+
+#include "extlibs.hpp"
+#include "assets.hpp"
+#include "writer.hpp"
+#include "md5.hpp"
+
+namespace fs = boost::filesystem;
+using namespace std;
+
+namespace xrextract {
+  /**
+   * Sinks selectable on the command line.
+   */
+  enum class sink_kind {
+    file,
+    null,
+    hash
+  };
+
+  /**
+   * Parse a sink name.
+   *
+   * @throws invalid_argument on unknown names.
+   */
+  sink_kind parse_sink_kind(const string& name);
+
+  /**
+   * Writes assets to files under the data file's destination directory.
+   */
+  class file_sink {
+  public:
+    explicit file_sink(const extract_options& opts);
+
+    void begin(const data_file& df, const asset_entry& ae);
+
+    void write(const char* data, size_t count) {
+      out->write(data, count);
+    }
+
+    void end(const asset_entry& ae);
+
+    /**
+     * Delete assets the data file marks as removed.
+     */
+    void removed(const data_file& df, const asset_entry& ae);
+
+    /**
+     * Finish dropping written assets from the page cache.
+     */
+    void finish();
+
+  private:
+    extract_options opts;
+    cache_releaser releaser;
+    unique_ptr<asset_writer> out;
+  };
+
+  /**
+   * Discards assets, to measure the read side on its own.
+   */
+  class null_sink {
+  public:
+    void begin(const data_file&, const asset_entry&) {}
+    void write(const char*, size_t) {}
+    void end(const asset_entry&) {}
+    void removed(const data_file&, const asset_entry&) {}
+  };
+
+  /**
+   * Verifies the MD5 checksum of assets against the .cat file, without
+   * writing them.
+   */
+  class hash_sink {
+  public:
+    void begin(const data_file& df, const asset_entry& ae);
+
+    void write(const char* data, size_t count) {
+      hash.update(data, count);
+    }
+
+    void end(const asset_entry& ae);
+
+    void removed(const data_file&, const asset_entry&) {}
+
+    /**
+     * Number of assets not matching their checksum so far.
+     */
+    uint64_t mismatches {0};
+
+  private:
+    md5_hash hash;
+    const data_file* current {nullptr};
+  };
+
+  /**
+   * Keeps assets in memory, for use as a library.
+   */
+  class memory_sink {
+  public:
+    void begin(const data_file&, const asset_entry& ae) {
+      assets.emplace_back(ae.filename, vector<char>{});
+      assets.back().second.reserve(ae.size);
+    }
+
+    void write(const char* data, size_t count) {
+      vector<char>& contents = assets.back().second;
+      contents.insert(contents.end(), data, data + count);
+    }
+
+    void end(const asset_entry&) {}
+    void removed(const data_file&, const asset_entry&) {}
+
+    /**
+     * Extracted assets and their contents, in .dat file order.
+     */
+    vector<pair<fs::path, vector<char>>> assets;
+  };
+
+  /**
+   * Hands asset chunks to a callable, for use as a library.
+   *
+   * The callable is invoked as callback(ae, data, count) for every chunk,
+   * in order.
+   */
+  template <typename Callback>
+  class callback_sink {
+  public:
+    explicit callback_sink(Callback callback)
+      : callback {move(callback)}
+    {}
+
+    void begin(const data_file&, const asset_entry& ae) {
+      current = &ae;
+    }
+
+    void write(const char* data, size_t count) {
+      callback(*current, data, count);
+    }
+
+    void end(const asset_entry&) {
+      current = nullptr;
+    }
+
+    void removed(const data_file&, const asset_entry&) {}
+
+  private:
+    Callback callback;
+    const asset_entry* current {nullptr};
+  };
+
+  template <typename Callback>
+  callback_sink<Callback> make_callback_sink(Callback callback) {
+    return callback_sink<Callback>(move(callback));
+  }
+
+  /**
+   * Callback sink taking any callable, at the cost of an indirect call
+   * per chunk.
+   */
+  typedef callback_sink<function<void(const asset_entry&, const char*, size_t)>> asset_callback_sink;
+}
+
+#endif // __SINKS_HPP
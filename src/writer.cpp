@@ -0,0 +1,294 @@
+/**
+ * @file
+ * Asset output file definitions file.
+ */
+
+// Visual studio mandates the the PCH source header file is included.
+#include "extlibs.hpp"
+#include "writer.hpp"
+#include "filesystem.hpp"
+
+namespace fs = boost::filesystem;
+using namespace std;
+
+namespace xrextract {
+  namespace {
+    /**
+    * Write buffer size, a multiple of the direct I/O alignment.
+    */
+    const size_t buffer_size {1 << 20};
+
+    /**
+    * Memory, offset and size alignment required by direct I/O.
+    *
+    * 4 KiB covers the logical block size of practically all devices.
+    */
+    const size_t direct_alignment {4096};
+
+    /**
+    * How much closed asset data may be queued before the batch is written
+    * back and dropped from the page cache.
+    */
+    const uint64_t release_budget {32 << 20};
+
+    /**
+    * How many closed asset files may be queued, to stay clear of the open
+    * file limit.
+    */
+    const size_t release_max_files {256};
+
+    void* allocate_buffer() {
+# if defined(WINDOWS_API)
+      void* memory = malloc(buffer_size);
+      if (memory == nullptr) {
+        throw bad_alloc();
+      }
+      return memory;
+# else
+      void* memory {nullptr};
+      if (posix_memalign(&memory, direct_alignment, buffer_size) != 0) {
+        throw bad_alloc();
+      }
+      return memory;
+# endif
+    }
+
+# if defined(POSIX_API)
+    void write_all(int fd, const char* data, size_t count, const fs::path& path) {
+      while (count) {
+        ssize_t written = ::write(fd, data, count);
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          throw posix_error("could not write to asset file", path, errno);
+        }
+        data += written;
+        count -= written;
+      }
+    }
+# endif
+  }
+
+  sync_mode parse_sync_mode(const string& name) {
+    if (name == "none") {
+      return sync_mode::none;
+    }
+    if (name == "file") {
+      return sync_mode::file;
+    }
+    if (name == "batch") {
+      return sync_mode::batch;
+    }
+    throw invalid_argument("unknown sync mode `" + name + "`, expected one of none, file, batch");
+  }
+
+  cache_releaser::~cache_releaser() {
+    try {
+      drain();
+    }
+    catch (const exception&) {
+      // Destructors must not throw, drain() explicitly to see errors.
+    }
+  }
+
+# if defined(POSIX_API)
+  void cache_releaser::add(int fd, uint64_t size, const fs::path& path) {
+    queued.push_back({fd, size, path});
+    queued_bytes += size;
+    if (queued_bytes > release_budget || queued.size() > release_max_files) {
+      drain();
+    }
+  }
+# endif
+
+  void cache_releaser::drain() {
+    if (queued.empty()) {
+      return;
+    }
+# if defined(__linux__)
+    // One writeback pass for the whole batch, so the file system can
+    // order it like it would on its own, instead of one per asset.
+    if (syncfs(queued.front().fd) != 0) {
+      throw posix_error("could not sync asset file", queued.front().path, errno);
+    }
+# endif
+    while (!queued.empty()) {
+      queued_file file {move(queued.front())};
+      queued.pop_front();
+      queued_bytes -= file.size;
+# if defined(POSIX_API)
+#   if defined(POSIX_FADV_DONTNEED)
+      posix_fadvise(file.fd, 0, 0, POSIX_FADV_DONTNEED);
+#   endif
+      if (::close(file.fd) != 0) {
+        throw posix_error("could not close asset file", file.path, errno);
+      }
+# endif
+    }
+  }
+
+  asset_writer::asset_writer(const fs::path& path, uint64_t size, const write_options& opts, cache_releaser* releaser)
+    : path {path},
+      opts {opts},
+      releaser {releaser},
+      direct {false},
+      buffer {static_cast<char*>(allocate_buffer()), free},
+      used {0},
+      flushed {0},
+      released {0}
+  {
+# if defined(WINDOWS_API)
+    out.open(path.string(), ios_base::out | ios_base::binary | ios_base::trunc);
+    if (!out.good()) {
+      throw runtime_error("error: could not open asset file " + path.string());
+    }
+# else
+    int flags {O_WRONLY | O_CREAT | O_TRUNC};
+#   if defined(O_DIRECT)
+    direct = opts.direct_threshold && size >= opts.direct_threshold;
+    if (direct) {
+      flags |= O_DIRECT;
+    }
+#   endif
+    fd = ::open(path.c_str(), flags, 0644);
+#   if defined(O_DIRECT)
+    if (fd < 0 && direct && errno == EINVAL) {
+      // File system does not support direct I/O, e.g. tmpfs.
+      direct = false;
+      fd = ::open(path.c_str(), flags & ~O_DIRECT, 0644);
+    }
+#   endif
+    if (fd < 0) {
+      throw posix_error("could not open asset file", path, errno);
+    }
+
+    if (opts.preallocate && size) {
+#   if defined(__linux__)
+      // Unlike posix_fallocate(), fails instead of writing out zeros when
+      // the file system cannot reserve space.
+      if (fallocate(fd, 0, 0, size) != 0 && errno != EOPNOTSUPP) {
+        int err {errno};
+        ::close(fd);
+        throw posix_error("could not preallocate asset file", path, err);
+      }
+#   elif defined(HAVE_POSIX_FALLOCATE)
+      int err = posix_fallocate(fd, 0, size);
+      if (err != 0 && err != EINVAL && err != EOPNOTSUPP) {
+        ::close(fd);
+        throw posix_error("could not preallocate asset file", path, err);
+      }
+#   endif
+    }
+# endif
+  }
+
+  asset_writer::~asset_writer() {
+# if defined(POSIX_API)
+    if (fd >= 0) {
+      ::close(fd);
+    }
+# endif
+  }
+
+  void asset_writer::write(const char* data, size_t count) {
+    while (count) {
+      size_t chunk = min(count, buffer_size - used);
+      memcpy(buffer.get() + used, data, chunk);
+      used += chunk;
+      data += chunk;
+      count -= chunk;
+      if (used == buffer_size) {
+        flush(false);
+      }
+    }
+  }
+
+  void asset_writer::flush(bool final) {
+# if defined(WINDOWS_API)
+    out.write(buffer.get(), used);
+    if (!out.good()) {
+      throw runtime_error("error: could not write to asset file");
+    }
+# else
+#   if defined(O_DIRECT)
+    if (direct && final && (used % direct_alignment)) {
+      // Direct I/O can only write whole blocks, the tail of the asset
+      // goes through the page cache.
+      size_t aligned = used - (used % direct_alignment);
+      write_all(fd, buffer.get(), aligned, path);
+      int flags = fcntl(fd, F_GETFL);
+      if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_DIRECT) < 0) {
+        throw posix_error("could not disable direct I/O on asset file", path, errno);
+      }
+      write_all(fd, buffer.get() + aligned, used - aligned, path);
+    }
+    else {
+      write_all(fd, buffer.get(), used, path);
+    }
+#   else
+    write_all(fd, buffer.get(), used, path);
+#   endif
+    flushed += used;
+    if (releaser && !final) {
+      release_cache();
+    }
+# endif
+    used = 0;
+  }
+
+  void asset_writer::release_cache() {
+# if defined(__linux__)
+    // Start writing back the chunk just written, and wait for everything
+    // before it, so that part can be dropped. The rest of the file is
+    // left to the cache releaser once closed.
+    uint64_t chunk_start {flushed - buffer_size};
+    sync_file_range(fd, chunk_start, buffer_size, SYNC_FILE_RANGE_WRITE);
+    if (chunk_start > released) {
+      sync_file_range(fd, released, chunk_start - released, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+      posix_fadvise(fd, released, chunk_start - released, POSIX_FADV_DONTNEED);
+      released = chunk_start;
+    }
+# else
+    // Without sync_file_range(), only pages already written back can be
+    // dropped, which is left to the cache releaser.
+# endif
+  }
+
+  void asset_writer::close() {
+    flush(true);
+# if defined(WINDOWS_API)
+    out.close();
+# else
+    if (opts.sync == sync_mode::file && fsync(fd) != 0) {
+      throw posix_error("could not sync asset file", path, errno);
+    }
+    int fd_closing {fd};
+    fd = -1;
+    if (releaser) {
+      releaser->add(fd_closing, flushed - released, path);
+      return;
+    }
+    if (::close(fd_closing) != 0) {
+      throw posix_error("could not close asset file", path, errno);
+    }
+# endif
+  }
+
+  void sync_destination(const fs::path& dest_dir) {
+# if defined(__linux__)
+    int fd = ::open(dest_dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+      throw posix_error("could not open destination directory", dest_dir, errno);
+    }
+    int result = syncfs(fd);
+    int err {errno};
+    ::close(fd);
+    if (result != 0) {
+      throw posix_error("could not sync destination directory", dest_dir, err);
+    }
+# elif defined(POSIX_API)
+    ::sync();
+# endif
+  }
+}
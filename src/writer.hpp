@@ -0,0 +1,163 @@
+/**
+ * @file
+ * Asset output file declarations.
+ */
+
+#ifndef __WRITER_HPP
+#define __WRITER_HPP
+
+#include "extlibs.hpp"
+
+namespace fs = boost::filesystem;
+using namespace std;
+
+namespace xrextract {
+  /**
+   * When extracted assets are synced to storage.
+   */
+  enum class sync_mode {
+    // Leave it to the operating system.
+    none,
+    // Sync every asset file as soon as it is written.
+    file,
+    // Sync the destination file system once, after all assets are written.
+    batch
+  };
+
+  /**
+   * How extracted assets are written out.
+   */
+  struct write_options {
+    /**
+    * Reserve the full asset size before writing, to avoid fragmentation.
+    */
+    bool preallocate;
+    /**
+    * Assets of at least this many bytes bypass the page cache, zero disables.
+    */
+    uint64_t direct_threshold;
+    sync_mode sync;
+  };
+
+  /**
+   * Parse a sync mode name.
+   *
+   * @throws invalid_argument on unknown names.
+   */
+  sync_mode parse_sync_mode(const string& name);
+
+  /**
+   * Drops written asset files from the page cache in batches, after they
+   * are closed.
+   *
+   * Writing back and waiting for each file as it is closed stalls on every
+   * small asset. Closed files are queued instead, and once enough data or
+   * files are queued the batch is written back in one go, dropped and
+   * closed.
+   */
+  class cache_releaser {
+  public:
+    cache_releaser() = default;
+    cache_releaser(const cache_releaser&) = delete;
+    cache_releaser& operator=(const cache_releaser&) = delete;
+
+    /**
+     * Drop and close what is still queued, ignoring errors.
+     */
+    ~cache_releaser();
+
+# if defined(POSIX_API)
+    /**
+     * Take over the descriptor of a fully written asset file.
+     *
+     * @param uint64_t size
+     *   Bytes of the file possibly still in the page cache.
+     */
+    void add(int fd, uint64_t size, const fs::path& path);
+# endif
+
+    /**
+     * Write back, drop and close all queued files.
+     */
+    void drain();
+
+  private:
+    struct queued_file {
+      int fd;
+      uint64_t size;
+      fs::path path;
+    };
+
+    deque<queued_file> queued;
+    uint64_t queued_bytes {0};
+  };
+
+  /**
+   * Output file of a single asset.
+   *
+   * Writes are buffered in an aligned buffer, so the same path serves both
+   * regular and direct I/O. Preallocation, direct I/O, page cache dropping
+   * and syncing are only done where the system supports them; elsewhere
+   * they are ignored.
+   */
+  class asset_writer {
+  public:
+    /**
+     * Create or truncate the asset file.
+     *
+     * @param const fs::path& path
+     *   Asset file to write.
+     *
+     * @param uint64_t size
+     *   Size of the asset in bytes, as listed in the .cat file.
+     *
+     * @param const write_options& opts
+     *   Write strategy.
+     *
+     * @param cache_releaser* releaser
+     *   Write back and drop asset data from the page cache as it is
+     *   written, finishing through `releaser` once closed. Null to leave
+     *   the page cache alone.
+     */
+    asset_writer(const fs::path& path, uint64_t size, const write_options& opts, cache_releaser* releaser);
+    asset_writer(const asset_writer&) = delete;
+    asset_writer& operator=(const asset_writer&) = delete;
+    ~asset_writer();
+
+    void write(const char* data, size_t count);
+
+    /**
+     * Flush the remaining data, sync if asked to and close the file.
+     */
+    void close();
+
+  private:
+    void flush(bool final);
+    void release_cache();
+
+    fs::path path;
+    write_options opts;
+    cache_releaser* releaser;
+    bool direct;
+    unique_ptr<char, void(*)(void*)> buffer;
+    size_t used;
+    // Bytes written to the file so far.
+    uint64_t flushed;
+    // Everything before this offset was dropped from the page cache.
+    uint64_t released;
+# if defined(WINDOWS_API)
+    ofstream out;
+# else
+    int fd;
+# endif
+  };
+
+  /**
+   * Sync everything written to the destination directory's file system.
+   *
+   * Used once at the end of extraction, in the batch sync mode.
+   */
+  void sync_destination(const fs::path& dest_dir);
+}
+
+#endif // __WRITER_HPP